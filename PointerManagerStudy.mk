@@ -60,7 +60,7 @@ AS       := /usr/bin/x86_64-linux-gnu-as
 ## User defined environment variables
 ##
 CodeLiteDir:=/usr/share/codelite
-Objects0=$(IntermediateDirectory)/src_main.c$(ObjectSuffix) $(IntermediateDirectory)/src_pointers.c$(ObjectSuffix) $(IntermediateDirectory)/src_debug.c$(ObjectSuffix) 
+Objects0=$(IntermediateDirectory)/src_main.c$(ObjectSuffix) $(IntermediateDirectory)/src_pointers.c$(ObjectSuffix) $(IntermediateDirectory)/src_debug.c$(ObjectSuffix) $(IntermediateDirectory)/src_memcopy.c$(ObjectSuffix) $(IntermediateDirectory)/src_numa.c$(ObjectSuffix) $(IntermediateDirectory)/src_handleio.c$(ObjectSuffix) $(IntermediateDirectory)/src_lz.c$(ObjectSuffix) 
 
 
 
@@ -109,6 +109,30 @@ $(IntermediateDirectory)/src_debug.c$(ObjectSuffix): src/debug.c
 $(IntermediateDirectory)/src_debug.c$(PreprocessSuffix): src/debug.c
 	$(CC) $(CFLAGS) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_debug.c$(PreprocessSuffix) src/debug.c
 
+$(IntermediateDirectory)/src_memcopy.c$(ObjectSuffix): src/memcopy.c
+	@$(CC) $(CFLAGS) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_memcopy.c$(ObjectSuffix) -MF$(IntermediateDirectory)/src_memcopy.c$(DependSuffix) -MM src/memcopy.c
+	$(CC) $(SourceSwitch) "/home/leandro/git/PointerManagerStudy/src/memcopy.c" $(CFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_memcopy.c$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_memcopy.c$(PreprocessSuffix): src/memcopy.c
+	$(CC) $(CFLAGS) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_memcopy.c$(PreprocessSuffix) src/memcopy.c
+
+$(IntermediateDirectory)/src_numa.c$(ObjectSuffix): src/numa.c
+	@$(CC) $(CFLAGS) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_numa.c$(ObjectSuffix) -MF$(IntermediateDirectory)/src_numa.c$(DependSuffix) -MM src/numa.c
+	$(CC) $(SourceSwitch) "/home/leandro/git/PointerManagerStudy/src/numa.c" $(CFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_numa.c$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_numa.c$(PreprocessSuffix): src/numa.c
+	$(CC) $(CFLAGS) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_numa.c$(PreprocessSuffix) src/numa.c
+
+$(IntermediateDirectory)/src_handleio.c$(ObjectSuffix): src/handleio.c
+	@$(CC) $(CFLAGS) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_handleio.c$(ObjectSuffix) -MF$(IntermediateDirectory)/src_handleio.c$(DependSuffix) -MM src/handleio.c
+	$(CC) $(SourceSwitch) "/home/leandro/git/PointerManagerStudy/src/handleio.c" $(CFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_handleio.c$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_handleio.c$(PreprocessSuffix): src/handleio.c
+	$(CC) $(CFLAGS) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_handleio.c$(PreprocessSuffix) src/handleio.c
+
+$(IntermediateDirectory)/src_lz.c$(ObjectSuffix): src/lz.c
+	@$(CC) $(CFLAGS) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_lz.c$(ObjectSuffix) -MF$(IntermediateDirectory)/src_lz.c$(DependSuffix) -MM src/lz.c
+	$(CC) $(SourceSwitch) "/home/leandro/git/PointerManagerStudy/src/lz.c" $(CFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_lz.c$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_lz.c$(PreprocessSuffix): src/lz.c
+	$(CC) $(CFLAGS) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_lz.c$(PreprocessSuffix) src/lz.c
+
 
 -include $(IntermediateDirectory)/*$(DependSuffix)
 ##
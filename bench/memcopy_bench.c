@@ -0,0 +1,162 @@
+/**
+ * @brief   Benchmark for memory copy kernels, it compares the plain memcpy
+ *          used by memCopyTo before the size tuned kernels against memCopy and,
+ *          from MEMCOPY_STREAM_SIZE, against memCopyStream with each kernel
+ *          supported by the running CPU, for sizes from 1 byte up to 64 KB.
+ *          Hot table copies always into the same destination (cached), cold
+ *          table walks a destination area greater than the last level cache.
+ *
+ *          Build and run from repository root:
+ *          gcc -O2 -Isrc bench/memcopy_bench.c src/memcopy.c src/debug.c -o memcopy_bench
+ *          ./memcopy_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "defs.h"
+#include "memcopy.h"
+#include "debug.h"
+
+#define BENCH_BYTES     (256u * 1024u * 1024u)  //!< Bytes copied for each size and kernel.
+#define BENCH_MAX_SIZE  (64u * 1024u)           //!< Greatest copy size.
+#define BENCH_COLD_AREA (64u * 1024u * 1024u)   //!< Destination area for cold copies.
+#define BENCH_MEMCPY    (-2)                    //!< Column for plain memcpy.
+#define BENCH_MEMCOPY   (-1)                    //!< Column for memCopy.
+
+static f64_t nowSeconds(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ((f64_t)ts.tv_sec + ((f64_t)ts.tv_nsec / 1e9));
+}
+
+/**
+ * @brief   Function to run copies of a size and return the throughput in MB/s.
+ * @param   kernel   Kernel used by memCopyStream, BENCH_MEMCPY for plain memcpy
+ *                   or BENCH_MEMCOPY for memCopy.
+ * @param   area     Destination area size, copies walk through it by steps of size.
+ */
+static f64_t runBench(const int kernel, u8_t *dst, const u8_t *src, const u32_t size, const u32_t area)
+{
+   u32_t loops = BENCH_BYTES / size;
+
+   if (loops > 4000000u)
+   {
+      loops = 4000000u;
+   }
+
+   u32_t offset = 0;
+   f64_t start  = nowSeconds();
+
+   for (u32_t idx = 0; idx < loops; idx++)
+   {
+      if (kernel == BENCH_MEMCPY)
+      {
+         memcpy(dst + offset, src, size);
+      }
+      else if (kernel == BENCH_MEMCOPY)
+      {
+         memCopy(dst + offset, src, size);
+      }
+      else
+      {
+         memCopyStream(dst + offset, src, size);
+      }
+
+      //Keep compiler from dropping the copies.
+      __asm__ volatile("" : : "r"(dst) : "memory");
+
+      offset += size;
+      if ((offset + size) > area)
+      {
+         offset = 0;
+      }
+   }
+
+   f64_t elapsed = nowSeconds() - start;
+
+   if (memcmp(dst, src, size) != 0)
+   {
+      ERROR("Copy result mismatch.");
+      exit(EXIT_FAILURE);
+   }
+
+   return (((f64_t)loops * size) / (elapsed * 1024.0 * 1024.0));
+}
+
+/**
+ * @brief   Function to print throughput of every kernel for sizes from 1 byte up to 64 KB.
+ * @param   area  Destination area size, 0 to copy always into the same destination.
+ */
+static void printTable(const char *title, const u8_t *src, u8_t *dst, const u32_t area)
+{
+   static const char *names[] = { "memcpy", "memCopy", "st-generic", "st-sse2", "st-avx2" };
+
+   printf("%8s", title);
+   for (int kernel = BENCH_MEMCPY; kernel <= MEMCOPY_AVX2; kernel++)
+   {
+      printf(" %10s", names[kernel - BENCH_MEMCPY]);
+   }
+   printf("   (MB/s)\n");
+
+   for (u32_t size = 1; size <= BENCH_MAX_SIZE; size *= 2)
+   {
+      printf("%8u", size);
+
+      for (int kernel = BENCH_MEMCPY; kernel <= MEMCOPY_AVX2; kernel++)
+      {
+         //Below the threshold memCopyStream runs the same code as memCopy.
+         if ((kernel >= 0) && (size < MEMCOPY_STREAM_SIZE))
+         {
+            printf(" %10s", "-");
+            continue;
+         }
+
+         if ((kernel >= 0) && (setMemCopyKernel((eMemCopyKernel_t)kernel) == FALSE))
+         {
+            printf(" %10s", "n/a");
+            continue;
+         }
+
+         //Unaligned destination by one byte, as handles are often used with offsets.
+         printf(" %10.0f", runBench(kernel, dst + 1, src, size, (area > 0) ? area : size));
+      }
+
+      printf("\n");
+   }
+
+   printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+   UNUSED(argc);
+   UNUSED(argv);
+
+   u8_t *src = CALLOC(BENCH_MAX_SIZE);
+   u8_t *dst = CALLOC(BENCH_COLD_AREA + 1);
+
+   if ((src == NULL) || (dst == NULL))
+   {
+      ERROR("Memory allocation error.");
+      return (EXIT_FAILURE);
+   }
+
+   for (u32_t idx = 0; idx < BENCH_MAX_SIZE; idx++)
+   {
+      src[idx] = (u8_t)(idx * 31u);
+   }
+
+   //Touch destination area so page faults are not measured.
+   memset(dst, 0xFF, BENCH_COLD_AREA + 1);
+
+   printTable("hot", src, dst, 0);
+   printTable("cold", src, dst, BENCH_COLD_AREA);
+
+   FREE(src);
+   FREE(dst);
+
+   return (EXIT_SUCCESS);
+}
@@ -0,0 +1,560 @@
+/*
+ * handleio.c
+ *
+ *  File descriptor I/O straight into and out of pointers manager handles.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "defs.h"
+#include "pointers.h"
+#include "handleio.h"
+#include "debug.h"
+
+#if !defined(HANDLEIO_NO_URING) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define HANDLEIO_URING 1   //!< Build io_uring backend, define HANDLEIO_NO_URING to leave it out.
+#endif
+
+/**
+ * @brief   Function to get the address of a handler segment, a segment to be
+ *          written gets its own copy when the handler memory is shared.
+ * @return  Segment address, NULL for invalid handler or overflow on handler memory.
+ */
+static u8_t *getSegment(const hndSeg_t *seg, const bool_t isWrite)
+{
+   ptr_t *p = NULL;
+
+   if (isNotInitialized() || (getPointerTo(&p, seg->hnd) == FALSE) || isFree(seg->hnd))
+   {
+      ERROR("Invalid parameter.");
+      return (NULL);
+   }
+
+   if (((u32_t)seg->offset + seg->len) > p->size)
+   {
+      ERROR("Overflow on handler buffer.");
+      return (NULL);
+   }
+
+   if (isWrite && (unshareHandle(seg->hnd) == FALSE))
+   {
+      return (NULL);
+   }
+
+   return ((u8_t*)p->ptr + seg->offset);
+}
+
+/**
+ * @brief   Function to fill an iovec array from handler segments.
+ * @return  TRUE for all segments valid.
+ */
+static bool_t getSegments(struct iovec *iov, const hndSeg_t *seg, const u16_t count, const bool_t isWrite)
+{
+   if ((seg == NULL) || (count == 0) || (count > HANDLEIO_MAX_SEGMENTS))
+   {
+      ERROR("Invalid parameter.");
+      return (FALSE);
+   }
+
+   for (u16_t idx = 0; idx < count; idx++)
+   {
+      iov[idx].iov_base = getSegment(&seg[idx], isWrite);
+      iov[idx].iov_len = seg[idx].len;
+
+      if (iov[idx].iov_base == NULL)
+      {
+         return (FALSE);
+      }
+   }
+
+   return (TRUE);
+}
+
+s32_t readIntoHandle(const int fd, const u16_t hnd, const u16_t offset, const u16_t len)
+{
+   hndSeg_t seg = { hnd, offset, len };
+   u8_t *addr = getSegment(&seg, TRUE);
+   ssize_t res;
+
+   if (addr == NULL)
+   {
+      return (-1);
+   }
+
+   do
+   {
+      res = read(fd, addr, len);
+   } while ((res < 0) && (errno == EINTR));
+
+   return ((s32_t)res);
+}
+
+s32_t writeFromHandle(const int fd, const u16_t hnd, const u16_t offset, const u16_t len)
+{
+   hndSeg_t seg = { hnd, offset, len };
+   u8_t *addr = getSegment(&seg, FALSE);
+   ssize_t res;
+
+   if (addr == NULL)
+   {
+      return (-1);
+   }
+
+   do
+   {
+      res = write(fd, addr, len);
+   } while ((res < 0) && (errno == EINTR));
+
+   return ((s32_t)res);
+}
+
+s32_t readvIntoHandles(const int fd, const hndSeg_t *seg, const u16_t count)
+{
+   struct iovec iov[HANDLEIO_MAX_SEGMENTS];
+   ssize_t res;
+
+   if (getSegments(iov, seg, count, TRUE) == FALSE)
+   {
+      return (-1);
+   }
+
+   do
+   {
+      res = readv(fd, iov, count);
+   } while ((res < 0) && (errno == EINTR));
+
+   return ((s32_t)res);
+}
+
+s32_t writevFromHandles(const int fd, const hndSeg_t *seg, const u16_t count)
+{
+   struct iovec iov[HANDLEIO_MAX_SEGMENTS];
+   ssize_t res;
+
+   if (getSegments(iov, seg, count, FALSE) == FALSE)
+   {
+      return (-1);
+   }
+
+   do
+   {
+      res = writev(fd, iov, count);
+   } while ((res < 0) && (errno == EINTR));
+
+   return ((s32_t)res);
+}
+
+/*
+ * Asynchronous queue. With io_uring requests go to the submission ring and
+ * results come from the completion ring. Without it, requests run at queue
+ * time and their results are kept in a circular completion array.
+ */
+
+typedef struct
+{
+   u64_t tag;     //!< User value.
+   s32_t result;  //!< Bytes transferred or negative errno.
+} hndIoDone_t;
+
+typedef struct
+{
+   u64_t  tag;    //!< User value.
+   u16_t  hnd;    //!< Handler pinned by request.
+   bool_t used;   //!< Slot in use.
+} hndIoReq_t;
+
+typedef struct
+{
+   u16_t        entries;    //!< Queue size, 0 for queue not created.
+   u16_t        queued;     //!< Requests queued and not yet submitted.
+   u16_t        pending;    //!< Requests submitted and not yet completed.
+   hndIoDone_t *done;       //!< Synchronous fallback completions.
+   u16_t        doneHead;   //!< First completion to be returned.
+#if defined(HANDLEIO_URING)
+   int                  fd;         //!< io_uring file descriptor, -1 for synchronous fallback.
+   hndIoReq_t          *req;        //!< Pending requests, indexed by io_uring user data.
+   void                *sqRing;     //!< Submission ring mapping.
+   size_t               sqRingSize; //!< Submission ring mapping size.
+   void                *cqRing;     //!< Completion ring mapping.
+   size_t               cqRingSize; //!< Completion ring mapping size.
+   struct io_uring_sqe *sqes;       //!< Submission entries.
+   size_t               sqesSize;   //!< Submission entries mapping size.
+   unsigned            *sqTail;
+   unsigned            *sqMask;
+   unsigned            *sqArray;
+   unsigned            *cqHead;
+   unsigned            *cqTail;
+   unsigned            *cqMask;
+   struct io_uring_cqe *cqes;
+#endif
+} hndIoQueue_t;
+
+static hndIoQueue_t queue;
+
+#if defined(HANDLEIO_URING)
+
+static bool_t initRing(const u16_t entries)
+{
+   struct io_uring_params params;
+   memset(&params, (BYTE)0, sizeof(params));
+
+   queue.fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+
+   if (queue.fd < 0)
+   {
+      return (FALSE);
+   }
+
+   //IORING_OP_READ/WRITE and offset -1 for current position came with the
+   //same kernel (5.6), an older ring would fail every request with -EINVAL.
+   if ((params.features & IORING_FEAT_RW_CUR_POS) == 0)
+   {
+      close(queue.fd);
+      queue.fd = -1;
+      return (FALSE);
+   }
+
+   queue.sqRingSize = params.sq_off.array + (params.sq_entries * sizeof(unsigned));
+   queue.cqRingSize = params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe));
+
+   if (params.features & IORING_FEAT_SINGLE_MMAP)
+   {
+      if (queue.cqRingSize > queue.sqRingSize)
+      {
+         queue.sqRingSize = queue.cqRingSize;
+      }
+      queue.cqRingSize = queue.sqRingSize;
+   }
+
+   queue.sqRing = mmap(NULL, queue.sqRingSize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, queue.fd, IORING_OFF_SQ_RING);
+
+   if (params.features & IORING_FEAT_SINGLE_MMAP)
+   {
+      queue.cqRing = queue.sqRing;
+   }
+   else
+   {
+      queue.cqRing = mmap(NULL, queue.cqRingSize, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, queue.fd, IORING_OFF_CQ_RING);
+   }
+
+   queue.sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+   queue.sqes = mmap(NULL, queue.sqesSize, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, queue.fd, IORING_OFF_SQES);
+
+   if ((queue.sqRing == MAP_FAILED) || (queue.cqRing == MAP_FAILED) || (queue.sqes == MAP_FAILED))
+   {
+      ERROR("io_uring mapping error.");
+
+      if (queue.sqes != MAP_FAILED)
+      {
+         munmap(queue.sqes, queue.sqesSize);
+      }
+
+      if ((queue.cqRing != MAP_FAILED) && (queue.cqRing != queue.sqRing))
+      {
+         munmap(queue.cqRing, queue.cqRingSize);
+      }
+
+      if (queue.sqRing != MAP_FAILED)
+      {
+         munmap(queue.sqRing, queue.sqRingSize);
+      }
+
+      close(queue.fd);
+      queue.fd = -1;
+      return (FALSE);
+   }
+
+   u8_t *sq = (u8_t*)queue.sqRing;
+   u8_t *cq = (u8_t*)queue.cqRing;
+
+   queue.sqTail  = (unsigned*)(sq + params.sq_off.tail);
+   queue.sqMask  = (unsigned*)(sq + params.sq_off.ring_mask);
+   queue.sqArray = (unsigned*)(sq + params.sq_off.array);
+   queue.cqHead  = (unsigned*)(cq + params.cq_off.head);
+   queue.cqTail  = (unsigned*)(cq + params.cq_off.tail);
+   queue.cqMask  = (unsigned*)(cq + params.cq_off.ring_mask);
+   queue.cqes    = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+   return (TRUE);
+}
+
+static void endRing(void)
+{
+   munmap(queue.sqes, queue.sqesSize);
+   if (queue.cqRing != queue.sqRing)
+   {
+      munmap(queue.cqRing, queue.cqRingSize);
+   }
+   munmap(queue.sqRing, queue.sqRingSize);
+   close(queue.fd);
+   queue.fd = -1;
+}
+
+static void queueRing(const u8_t opcode, const int fd, u8_t *addr, const u16_t len,
+                      const s64_t fileOffset, const u16_t slot)
+{
+   unsigned tail = *queue.sqTail;
+   unsigned idx = tail & *queue.sqMask;
+   struct io_uring_sqe *sqe = &queue.sqes[idx];
+
+   memset(sqe, (BYTE)0, sizeof(*sqe));
+   sqe->opcode = opcode;
+   sqe->fd = fd;
+   sqe->addr = (u64_t)(size_t)addr;
+   sqe->len = len;
+   sqe->off = (u64_t)fileOffset;
+   sqe->user_data = slot;
+
+   queue.sqArray[idx] = idx;
+   __atomic_store_n(queue.sqTail, tail + 1, __ATOMIC_RELEASE);
+}
+
+#endif //HANDLEIO_URING
+
+bool_t isHandleIoRing(void)
+{
+#if defined(HANDLEIO_URING)
+   return (((queue.entries > 0) && (queue.fd >= 0)) ? TRUE : FALSE);
+#else
+   return (FALSE);
+#endif
+}
+
+bool_t initHandleIoQueue(const u16_t entries)
+{
+   ASSERT(queue.entries == 0);
+
+   if ((queue.entries > 0) || (entries == 0))
+   {
+      return (FALSE);
+   }
+
+   memset(&queue, (BYTE)0, sizeof(queue));
+
+#if defined(HANDLEIO_URING)
+   if (initRing(entries) == TRUE)
+   {
+      queue.req = CALLOC(entries * sizeof(hndIoReq_t));
+
+      if (queue.req == NULL)
+      {
+         ERROR("Memory allocation error.");
+         endRing();
+         return (FALSE);
+      }
+
+      queue.entries = entries;
+      return (TRUE);
+   }
+
+   WARNING("io_uring not available, synchronous I/O is used.");
+#endif
+
+   queue.done = CALLOC(entries * sizeof(hndIoDone_t));
+
+   if (queue.done == NULL)
+   {
+      ERROR("Memory allocation error.");
+      return (FALSE);
+   }
+
+   queue.entries = entries;
+
+   return (TRUE);
+}
+
+void endHandleIoQueue(void)
+{
+   u64_t  tag;
+   s32_t  result;
+
+   if (queue.entries == 0)
+   {
+      return;
+   }
+
+   //Kernel may still write into handler memory, wait for all requests.
+   while (waitHandleIo(&tag, &result) == TRUE)
+   {
+   }
+
+#if defined(HANDLEIO_URING)
+   if (isHandleIoRing())
+   {
+      endRing();
+      FREE(queue.req);
+   }
+#endif
+
+   FREE(queue.done);
+   memset(&queue, (BYTE)0, sizeof(queue));
+}
+
+static bool_t queueRequest(const bool_t isRead, const int fd, hndSeg_t seg,
+                           const s64_t fileOffset, const u64_t tag)
+{
+   if ((queue.entries == 0) || ((queue.queued + queue.pending) >= queue.entries))
+   {
+      ERROR("I/O queue not created or full.");
+      return (FALSE);
+   }
+
+   u8_t *addr = getSegment(&seg, isRead);
+
+   if (addr == NULL)
+   {
+      return (FALSE);
+   }
+
+#if defined(HANDLEIO_URING)
+   if (isHandleIoRing())
+   {
+      u16_t slot = 0;
+
+      while (queue.req[slot].used == TRUE)
+      {
+         slot++;
+      }
+
+      //Kernel accesses the block until completion, it must not move meanwhile.
+      if (pinHandle(seg.hnd) == FALSE)
+      {
+         return (FALSE);
+      }
+
+      queue.req[slot].tag = tag;
+      queue.req[slot].hnd = seg.hnd;
+      queue.req[slot].used = TRUE;
+
+      queueRing(isRead ? IORING_OP_READ : IORING_OP_WRITE, fd, addr, seg.len, fileOffset, slot);
+      queue.queued++;
+      return (TRUE);
+   }
+#endif
+
+   ssize_t res;
+
+   do
+   {
+      if (isRead)
+      {
+         res = (fileOffset < 0) ? read(fd, addr, seg.len) : pread(fd, addr, seg.len, fileOffset);
+      }
+      else
+      {
+         res = (fileOffset < 0) ? write(fd, addr, seg.len) : pwrite(fd, addr, seg.len, fileOffset);
+      }
+   } while ((res < 0) && (errno == EINTR));
+
+   hndIoDone_t *done = &queue.done[(queue.doneHead + queue.queued + queue.pending) % queue.entries];
+   done->tag = tag;
+   done->result = (res < 0) ? -errno : (s32_t)res;
+   queue.queued++;
+
+   return (TRUE);
+}
+
+bool_t queueReadIntoHandle(const int fd, const hndSeg_t seg, const s64_t fileOffset, const u64_t tag)
+{
+   return (queueRequest(TRUE, fd, seg, fileOffset, tag));
+}
+
+bool_t queueWriteFromHandle(const int fd, const hndSeg_t seg, const s64_t fileOffset, const u64_t tag)
+{
+   return (queueRequest(FALSE, fd, seg, fileOffset, tag));
+}
+
+u16_t submitHandleIo(void)
+{
+   u16_t submitted = queue.queued;
+
+   if (submitted == 0)
+   {
+      return (0);
+   }
+
+#if defined(HANDLEIO_URING)
+   if (isHandleIoRing())
+   {
+      int res;
+
+      do
+      {
+         res = (int)syscall(__NR_io_uring_enter, queue.fd, queue.queued, 0, 0, NULL, 0);
+      } while ((res < 0) && (errno == EINTR));
+
+      if (res < 0)
+      {
+         ERROR("io_uring submission error.");
+         return (0);
+      }
+
+      submitted = (u16_t)res;
+   }
+#endif
+
+   queue.queued -= submitted;
+   queue.pending += submitted;
+
+   return (submitted);
+}
+
+bool_t waitHandleIo(u64_t *tag, s32_t *result)
+{
+   if ((tag == NULL) || (result == NULL) || (queue.entries == 0))
+   {
+      return (FALSE);
+   }
+
+   if ((queue.pending == 0) && (submitHandleIo() == 0))
+   {
+      return (FALSE);
+   }
+
+#if defined(HANDLEIO_URING)
+   if (isHandleIoRing())
+   {
+      unsigned head = *queue.cqHead;
+
+      while (head == __atomic_load_n(queue.cqTail, __ATOMIC_ACQUIRE))
+      {
+         if ((syscall(__NR_io_uring_enter, queue.fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0) &&
+             (errno != EINTR))
+         {
+            ERROR("io_uring completion error.");
+            return (FALSE);
+         }
+      }
+
+      struct io_uring_cqe *cqe = &queue.cqes[head & *queue.cqMask];
+      hndIoReq_t *req = &queue.req[cqe->user_data];
+
+      *tag = req->tag;
+      *result = cqe->res;
+      unpinHandle(req->hnd);
+      req->used = FALSE;
+
+      __atomic_store_n(queue.cqHead, head + 1, __ATOMIC_RELEASE);
+      queue.pending--;
+
+      return (TRUE);
+   }
+#endif
+
+   *tag = queue.done[queue.doneHead].tag;
+   *result = queue.done[queue.doneHead].result;
+   queue.doneHead = (queue.doneHead + 1) % queue.entries;
+   queue.pending--;
+
+   return (TRUE);
+}
@@ -0,0 +1,144 @@
+/*
+ * handleio.h
+ *
+ *  File descriptor I/O straight into and out of pointers manager handles.
+ */
+
+#ifndef SRC_HANDLEIO_H_
+#define SRC_HANDLEIO_H_
+
+#include "defs.h"
+
+#define HANDLEIO_MAX_SEGMENTS  64u   //!< Greatest number of segments on a vectored call.
+
+/**
+ * @brief   Structure to declare a segment of a handle memory for vectored I/O.
+ */
+typedef struct
+{
+   u16_t hnd;     //!< Handler number.
+   u16_t offset;  //!< Offset into handler memory.
+   u16_t len;     //!< Amount of bytes.
+} hndSeg_t;
+
+
+/**
+ * @brief   Function to read from a file descriptor straight into handler memory.
+ * @param   fd       File descriptor (file, pipe or socket).
+ * @param   hnd      Destination handler number.
+ * @param   offset   Offset into handler memory.
+ * @param   len      Amount of bytes to be read.
+ * @return  0..len   Bytes read, 0 for end of file.
+ *          -1       Invalid parameter, overflow on handler memory or read error.
+ */
+s32_t readIntoHandle(int fd, u16_t hnd, u16_t offset, u16_t len);
+
+
+/**
+ * @brief   Function to write handler memory straight to a file descriptor.
+ * @param   fd       File descriptor (file, pipe or socket).
+ * @param   hnd      Origin handler number.
+ * @param   offset   Offset into handler memory.
+ * @param   len      Amount of bytes to be written.
+ * @return  0..len   Bytes written.
+ *          -1       Invalid parameter, overflow on handler memory or write error.
+ */
+s32_t writeFromHandle(int fd, u16_t hnd, u16_t offset, u16_t len);
+
+
+/**
+ * @brief   Function to read from a file descriptor into several handler
+ *          segments by a single system call, segments are filled in order.
+ * @param   fd       File descriptor.
+ * @param   *seg     Array of segments.
+ * @param   count    Number of segments, up to HANDLEIO_MAX_SEGMENTS.
+ * @return  0..N     Bytes read.
+ *          -1       Invalid parameter, overflow on handler memory or read error.
+ */
+s32_t readvIntoHandles(int fd, const hndSeg_t *seg, u16_t count);
+
+
+/**
+ * @brief   Function to write several handler segments to a file descriptor by
+ *          a single system call, segments are written in order.
+ * @param   fd       File descriptor.
+ * @param   *seg     Array of segments.
+ * @param   count    Number of segments, up to HANDLEIO_MAX_SEGMENTS.
+ * @return  0..N     Bytes written.
+ *          -1       Invalid parameter, overflow on handler memory or write error.
+ */
+s32_t writevFromHandles(int fd, const hndSeg_t *seg, u16_t count);
+
+
+/**
+ * @brief   Function to create the queue for batched asynchronous I/O. It uses
+ *          io_uring when the kernel supports it (5.6 or later, needed for
+ *          read and write at current position), otherwise requests are run
+ *          synchronously at submission and only their results are queued.
+ *          With io_uring a handler is pinned (pinHandle) from queueing until its
+ *          completion is returned by waitHandleIo: meanwhile it can't be released,
+ *          shared, unshared by copy on write (memCopyTo, read into it) or compressed.
+ * @param   entries  Greatest number of pending requests.
+ * @return  TRUE     Successful.
+ *          FALSE    Error or queue already created.
+ */
+bool_t initHandleIoQueue(u16_t entries);
+
+
+/**
+ * @brief   Function to release the asynchronous I/O queue, pending requests
+ *          are waited before.
+ */
+void endHandleIoQueue(void);
+
+
+/**
+ * @brief   Function to check if the asynchronous I/O queue uses io_uring.
+ * @return  TRUE     io_uring in use.
+ *          FALSE    Synchronous fallback in use or queue not created.
+ */
+bool_t isHandleIoRing(void);
+
+
+/**
+ * @brief   Function to queue a read from a file descriptor into handler memory.
+ * @param   fd          File descriptor.
+ * @param   seg         Destination handler segment.
+ * @param   fileOffset  Offset into file, -1 for current position or sockets.
+ * @param   tag         User value returned with request completion.
+ * @return  TRUE        Request queued.
+ *          FALSE       Invalid parameter or queue full.
+ */
+bool_t queueReadIntoHandle(int fd, hndSeg_t seg, s64_t fileOffset, u64_t tag);
+
+
+/**
+ * @brief   Function to queue a write of handler memory to a file descriptor.
+ * @param   fd          File descriptor.
+ * @param   seg         Origin handler segment.
+ * @param   fileOffset  Offset into file, -1 for current position or sockets.
+ * @param   tag         User value returned with request completion.
+ * @return  TRUE        Request queued.
+ *          FALSE       Invalid parameter or queue full.
+ */
+bool_t queueWriteFromHandle(int fd, hndSeg_t seg, s64_t fileOffset, u64_t tag);
+
+
+/**
+ * @brief   Function to submit all queued requests by a single system call.
+ * @return  0..N  Number of requests submitted.
+ */
+u16_t submitHandleIo(void);
+
+
+/**
+ * @brief   Function to wait for a request completion.
+ * @param   *tag     Where the request tag will be stored.
+ * @param   *result  Where the request result will be stored, bytes transferred
+ *                   or a negative errno value.
+ * @return  TRUE     Completion returned.
+ *          FALSE    Invalid parameter or no request pending.
+ */
+bool_t waitHandleIo(u64_t *tag, s32_t *result);
+
+#endif /* SRC_HANDLEIO_H_ */
@@ -0,0 +1,283 @@
+/*
+ * lz.c
+ *
+ *  Fast LZ77 block codec (LZ4 like format) used to compress cold blocks.
+ *
+ *  A block is a list of sequences, each one is:
+ *    token          high nibble literal length, low nibble match length - 4,
+ *                   value 15 means more length bytes follow (255 adds and continues).
+ *    literal length extra bytes, literals.
+ *    offset         2 bytes little endian, distance back to the match.
+ *    match length   extra bytes.
+ *  Last sequence has only literals and ends the block.
+ */
+
+#include <string.h>
+#include "defs.h"
+#include "lz.h"
+
+#define LZ_MIN_MATCH    4u    //!< Shortest match encoded.
+#define LZ_LAST_LITERALS 5u   //!< Last bytes of a block always go as literals.
+#define LZ_HASH_BITS    12u   //!< Greatest hash table, 4096 positions.
+#define LZ_MIN_HASH_BITS 4u   //!< Smallest hash table, 16 positions.
+#define LZ_MAX_OFFSET   0xFFFFu
+
+static u32_t read32(const u8_t *p)
+{
+   u32_t value;
+   memcpy(&value, p, sizeof(value));
+   return (value);
+}
+
+static u32_t hash32(const u32_t value, const u32_t bits)
+{
+   return ((value * 2654435761u) >> (32u - bits));
+}
+
+/**
+ * @brief   Function to write a length over 15 as extra bytes.
+ * @return  Next output position, NULL for no room.
+ */
+static u8_t *writeLength(u8_t *op, const u8_t *oend, u32_t len)
+{
+   while (len >= 255)
+   {
+      if (op >= oend)
+      {
+         return (NULL);
+      }
+
+      *op++ = 255;
+      len -= 255;
+   }
+
+   if (op >= oend)
+   {
+      return (NULL);
+   }
+
+   *op++ = (u8_t)len;
+
+   return (op);
+}
+
+/**
+ * @brief   Function to write a sequence, a match length 0 writes the last one.
+ * @return  Next output position, NULL for no room.
+ */
+static u8_t *writeSequence(u8_t *op, const u8_t *oend, const u8_t *literals,
+                           const u32_t litLen, const u32_t offset, const u32_t matchLen)
+{
+   if (op >= oend)
+   {
+      return (NULL);
+   }
+
+   u8_t *token = op++;
+   u32_t code = (matchLen > 0) ? (matchLen - LZ_MIN_MATCH) : 0;
+
+   *token = (u8_t)(((litLen < 15) ? litLen : 15) << 4);
+
+   if ((litLen >= 15) && ((op = writeLength(op, oend, litLen - 15)) == NULL))
+   {
+      return (NULL);
+   }
+
+   if ((u32_t)(oend - op) < litLen)
+   {
+      return (NULL);
+   }
+
+   memcpy(op, literals, litLen);
+   op += litLen;
+
+   if (matchLen == 0)
+   {
+      return (op);
+   }
+
+   if ((oend - op) < 2)
+   {
+      return (NULL);
+   }
+
+   *op++ = (u8_t)(offset & 0xFF);
+   *op++ = (u8_t)(offset >> 8);
+
+   *token |= (u8_t)((code < 15) ? code : 15);
+
+   if ((code >= 15) && ((op = writeLength(op, oend, code - 15)) == NULL))
+   {
+      return (NULL);
+   }
+
+   return (op);
+}
+
+u32_t lzCompress(const u8_t *src, const u32_t srcSize, u8_t *dst, const u32_t dstCap)
+{
+   static u32_t table[1u << LZ_HASH_BITS];
+
+   const u8_t *oend   = dst + dstCap;
+   u8_t       *op     = dst;
+   u32_t       anchor = 0;
+   u32_t       ip     = 0;
+
+   if ((src == NULL) || (dst == NULL))
+   {
+      return (0);
+   }
+
+   //Table sized by block, about one position for each 4 bytes, so clearing
+   //it never costs more than the block itself.
+   u32_t bits = LZ_MIN_HASH_BITS;
+
+   while ((bits < LZ_HASH_BITS) && ((1u << (bits + 2)) < srcSize))
+   {
+      bits++;
+   }
+
+   memset(table, (BYTE)0, (1u << bits) * sizeof(table[0]));
+
+   if (srcSize > (LZ_MIN_MATCH + LZ_LAST_LITERALS))
+   {
+      const u32_t matchLimit = srcSize - LZ_LAST_LITERALS;
+
+      while ((ip + LZ_MIN_MATCH) <= matchLimit)
+      {
+         u32_t seq  = read32(src + ip);
+         u32_t h    = hash32(seq, bits);
+         u32_t cand = table[h];
+
+         table[h] = ip;
+
+         if ((cand < ip) && ((ip - cand) <= LZ_MAX_OFFSET) && (read32(src + cand) == seq))
+         {
+            u32_t len = LZ_MIN_MATCH;
+
+            while (((ip + len) < matchLimit) && (src[cand + len] == src[ip + len]))
+            {
+               len++;
+            }
+
+            op = writeSequence(op, oend, src + anchor, ip - anchor, ip - cand, len);
+
+            if (op == NULL)
+            {
+               return (0);
+            }
+
+            ip += len;
+            anchor = ip;
+         }
+         else
+         {
+            ip++;
+         }
+      }
+   }
+
+   op = writeSequence(op, oend, src + anchor, srcSize - anchor, 0, 0);
+
+   return ((op == NULL) ? 0 : (u32_t)(op - dst));
+}
+
+/**
+ * @brief   Function to read a length over 15 from extra bytes.
+ * @return  FALSE for input overrun.
+ */
+static bool_t readLength(const u8_t **ip, const u8_t *iend, u32_t *len)
+{
+   u8_t byte;
+
+   do
+   {
+      if (*ip >= iend)
+      {
+         return (FALSE);
+      }
+
+      byte = *(*ip)++;
+      *len += byte;
+   } while (byte == 255);
+
+   return (TRUE);
+}
+
+bool_t lzDecompress(const u8_t *src, const u32_t srcSize, u8_t *dst, const u32_t dstSize)
+{
+   const u8_t *ip   = src;
+   const u8_t *iend = src + srcSize;
+   u8_t       *op   = dst;
+   const u8_t *oend = dst + dstSize;
+
+   if ((src == NULL) || (dst == NULL))
+   {
+      return (FALSE);
+   }
+
+   while (ip < iend)
+   {
+      u8_t  token  = *ip++;
+      u32_t litLen = token >> 4;
+
+      if ((litLen == 15) && (readLength(&ip, iend, &litLen) == FALSE))
+      {
+         return (FALSE);
+      }
+
+      if (((u32_t)(iend - ip) < litLen) || ((u32_t)(oend - op) < litLen))
+      {
+         return (FALSE);
+      }
+
+      memcpy(op, ip, litLen);
+      ip += litLen;
+      op += litLen;
+
+      //Last sequence has no match.
+      if (ip == iend)
+      {
+         break;
+      }
+
+      if ((iend - ip) < 2)
+      {
+         return (FALSE);
+      }
+
+      u32_t offset   = (u32_t)ip[0] | ((u32_t)ip[1] << 8);
+      u32_t matchLen = token & 0x0F;
+      ip += 2;
+
+      if ((matchLen == 15) && (readLength(&ip, iend, &matchLen) == FALSE))
+      {
+         return (FALSE);
+      }
+
+      matchLen += LZ_MIN_MATCH;
+
+      if ((offset == 0) || (offset > (u32_t)(op - dst)) || ((u32_t)(oend - op) < matchLen))
+      {
+         return (FALSE);
+      }
+
+      const u8_t *match = op - offset;
+
+      if (offset >= matchLen)
+      {
+         memcpy(op, match, matchLen);
+         op += matchLen;
+      }
+      else
+      {
+         //Overlapped match repeats the last offset bytes.
+         for (u32_t idx = 0; idx < matchLen; idx++)
+         {
+            *op++ = *match++;
+         }
+      }
+   }
+
+   return ((op == oend) ? TRUE : FALSE);
+}
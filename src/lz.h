@@ -0,0 +1,35 @@
+/*
+ * lz.h
+ *
+ *  Fast LZ77 block codec (LZ4 like format) used to compress cold blocks.
+ */
+
+#ifndef SRC_LZ_H_
+#define SRC_LZ_H_
+
+#include "defs.h"
+
+/**
+ * @brief   Function to compress a block of memory.
+ * @param   *src     Origin data.
+ * @param   srcSize  Origin data size.
+ * @param   *dst     Destination buffer.
+ * @param   dstCap   Destination buffer size.
+ * @return  1..N     Compressed size.
+ *          0        Compressed data doesn't fit into destination buffer.
+ */
+u32_t lzCompress(const u8_t *src, u32_t srcSize, u8_t *dst, u32_t dstCap);
+
+
+/**
+ * @brief   Function to decompress a block compressed by lzCompress.
+ * @param   *src     Compressed data.
+ * @param   srcSize  Compressed data size.
+ * @param   *dst     Destination buffer.
+ * @param   dstSize  Original data size, the destination buffer must be filled exactly.
+ * @return  TRUE     Successful.
+ *          FALSE    Corrupted data or size mismatch.
+ */
+bool_t lzDecompress(const u8_t *src, u32_t srcSize, u8_t *dst, u32_t dstSize);
+
+#endif /* SRC_LZ_H_ */
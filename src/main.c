@@ -8,8 +8,22 @@
 #include <stdlib.h>
 #include "defs.h"
 #include "pointers.h"
+#include "typedpool.h"
 #include "debug.h"
 
+/**
+ * @brief   Message header example, handled by a typed pool.
+ */
+typedef struct
+{
+   u32_t id;      //!< Message identification.
+   u16_t length;  //!< Message payload length.
+   u16_t hnd;     //!< Pointers manager handle where the payload is stored.
+} MsgHeader;
+
+DECLARE_TYPED_POOL(MsgHeader, 64);
+DEFINE_TYPED_POOL(MsgHeader);
+
 /**
  * @brief   Main program entrie function, here the program start its execution.
  * @param   argc Not used.
@@ -30,7 +44,7 @@ int main(int argc, char **argv)
 
    u32_t hndPointer = 0;
 
-   if (initPointerManager(1024))
+   if (initPointerManagerNuma(1024, 1024 * 1024))
    {
       printf("pointers manager initialized.\n");
    }
@@ -58,6 +72,7 @@ int main(int argc, char **argv)
    {
       printf("checked get pointer structure by handler.\n");
       printf("ptr size: %u\n", ptr->size);
+      printf("ptr node: %u of %u\n", getHandleNode(hndPointer), getNumaNodes());
    }
 
    printf("handlers free:%u\n", getFreeHandles());
@@ -82,6 +97,23 @@ int main(int argc, char **argv)
 
    ASSERT(result == TRUE);
 
+   u16_t hndHeader = MsgHeaderPoolAlloc();
+   MsgHeader *header = MsgHeaderPoolGet(hndHeader);
+
+   if (header != NULL)
+   {
+      header->id = 1;
+      header->length = 128;
+      header->hnd = hndPointer;
+      printf("message header (%u) allocated from typed pool, used:%u of %u.\n",
+             hndHeader, MsgHeaderPoolUsed(), MsgHeaderPoolSize());
+   }
+
+   if (MsgHeaderPoolFree(hndHeader))
+   {
+      printf("message header (%u) released, used:%u.\n", hndHeader, MsgHeaderPoolUsed());
+   }
+
    /*
     if (endPointerManager() == FALSE)
     {
@@ -0,0 +1,214 @@
+/*
+ * memcopy.c
+ *
+ *  Size tuned memory copy kernels used by pointers manager.
+ */
+
+#include <string.h>
+#include "defs.h"
+#include "memcopy.h"
+#include "debug.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MEMCOPY_X86 1   //!< Enable SSE2/AVX2 kernels.
+#endif
+
+/**
+ * @brief   Function to copy a small amount of bytes (up to MEMCOPY_SMALL_SIZE)
+ *          by two overlapped fixed size moves, without any loop.
+ */
+static void memCopySmall(void *dst, const void *src, const u32_t size)
+{
+   u8_t       *d = (u8_t*)dst;
+   const u8_t *s = (const u8_t*)src;
+
+   if (size >= 8)
+   {
+      u64_t head, tail;
+      memcpy(&head, s, 8);
+      memcpy(&tail, s + size - 8, 8);
+      memcpy(d, &head, 8);
+      memcpy(d + size - 8, &tail, 8);
+   }
+   else if (size >= 4)
+   {
+      u32_t head, tail;
+      memcpy(&head, s, 4);
+      memcpy(&tail, s + size - 4, 4);
+      memcpy(d, &head, 4);
+      memcpy(d + size - 4, &tail, 4);
+   }
+   else if (size > 0)
+   {
+      d[0] = s[0];
+      d[size >> 1] = s[size >> 1];
+      d[size - 1] = s[size - 1];
+   }
+}
+
+typedef void (*memCopyFn_t)(u8_t *dst, const u8_t *src, u32_t size);
+
+static void copyGeneric(u8_t *dst, const u8_t *src, u32_t size)
+{
+   memcpy(dst, src, size);
+}
+
+#if defined(MEMCOPY_X86)
+
+/*
+ * Streaming kernels, used by memCopyStream for copies from MEMCOPY_STREAM_SIZE.
+ * Head and tail are unaligned moves, the loop in between does non-temporal
+ * stores on aligned destination addresses, so the block goes to memory without
+ * evicting the working set from cache.
+ */
+
+__attribute__((target("sse2")))
+static void copySSE2(u8_t *dst, const u8_t *src, u32_t size)
+{
+   __m128i head = _mm_loadu_si128((const __m128i*)src);
+   __m128i tail = _mm_loadu_si128((const __m128i*)(src + size - 16));
+   u32_t   idx  = 16 - ((u32_t)(size_t)dst & 15);
+
+   for (; (idx + 16) <= size; idx += 16)
+   {
+      _mm_stream_si128((__m128i*)(dst + idx), _mm_loadu_si128((const __m128i*)(src + idx)));
+   }
+
+   _mm_sfence();
+
+   _mm_storeu_si128((__m128i*)dst, head);
+   _mm_storeu_si128((__m128i*)(dst + size - 16), tail);
+}
+
+__attribute__((target("avx2")))
+static void copyAVX2(u8_t *dst, const u8_t *src, u32_t size)
+{
+   __m256i head = _mm256_loadu_si256((const __m256i*)src);
+   __m256i tail = _mm256_loadu_si256((const __m256i*)(src + size - 32));
+   u32_t   idx  = 32 - ((u32_t)(size_t)dst & 31);
+
+   for (; (idx + 32) <= size; idx += 32)
+   {
+      _mm256_stream_si256((__m256i*)(dst + idx), _mm256_loadu_si256((const __m256i*)(src + idx)));
+   }
+
+   _mm_sfence();
+
+   _mm256_storeu_si256((__m256i*)dst, head);
+   _mm256_storeu_si256((__m256i*)(dst + size - 32), tail);
+}
+
+#endif //MEMCOPY_X86
+
+static memCopyFn_t      copyFn     = NULL;               //!< Streaming kernel in use, NULL until first call.
+static eMemCopyKernel_t copyKernel = MEMCOPY_GENERIC;    //!< Kernel identifier in use.
+
+static bool_t isKernelSupported(const eMemCopyKernel_t kernel)
+{
+   switch (kernel)
+   {
+      case MEMCOPY_GENERIC:
+         return (TRUE);
+
+#if defined(MEMCOPY_X86)
+      case MEMCOPY_SSE2:
+         return (__builtin_cpu_supports("sse2") ? TRUE : FALSE);
+
+      case MEMCOPY_AVX2:
+         return (__builtin_cpu_supports("avx2") ? TRUE : FALSE);
+#endif
+
+      default:
+         return (FALSE);
+   }
+}
+
+static bool_t selectKernel(const eMemCopyKernel_t kernel)
+{
+   if (isKernelSupported(kernel) == FALSE)
+   {
+      return (FALSE);
+   }
+
+   switch (kernel)
+   {
+#if defined(MEMCOPY_X86)
+      case MEMCOPY_SSE2:
+         copyFn = copySSE2;
+         break;
+
+      case MEMCOPY_AVX2:
+         copyFn = copyAVX2;
+         break;
+#endif
+
+      default:
+         copyFn = copyGeneric;
+         break;
+   }
+
+   copyKernel = kernel;
+
+   return (TRUE);
+}
+
+bool_t setMemCopyKernel(const eMemCopyKernel_t kernel)
+{
+   if (selectKernel(kernel) == FALSE)
+   {
+      WARNING("Memory copy kernel not supported by this CPU.");
+      return (FALSE);
+   }
+
+   return (TRUE);
+}
+
+eMemCopyKernel_t getMemCopyKernel(void)
+{
+   if (copyFn == NULL)
+   {
+      //Select the best kernel supported by running CPU.
+      if (selectKernel(MEMCOPY_AVX2) == FALSE)
+      {
+         if (selectKernel(MEMCOPY_SSE2) == FALSE)
+         {
+            selectKernel(MEMCOPY_GENERIC);
+         }
+      }
+   }
+
+   return (copyKernel);
+}
+
+void memCopy(void *dst, const void *src, const u32_t size)
+{
+   ASSERT((dst != NULL) && (src != NULL));
+
+   if (size <= MEMCOPY_SMALL_SIZE)
+   {
+      memCopySmall(dst, src, size);
+      return;
+   }
+
+   //Library memcpy already has its own vector kernels for cached copies.
+   memcpy(dst, src, size);
+}
+
+void memCopyStream(void *dst, const void *src, const u32_t size)
+{
+   ASSERT((dst != NULL) && (src != NULL));
+
+   if (size < MEMCOPY_STREAM_SIZE)
+   {
+      memCopy(dst, src, size);
+      return;
+   }
+
+   if (copyFn == NULL)
+   {
+      getMemCopyKernel();
+   }
+
+   copyFn((u8_t*)dst, (const u8_t*)src, size);
+}
@@ -0,0 +1,73 @@
+/*
+ * memcopy.h
+ *
+ *  Size tuned memory copy kernels used by pointers manager.
+ */
+
+#ifndef SRC_MEMCOPY_H_
+#define SRC_MEMCOPY_H_
+
+#include "defs.h"
+
+/**
+ * @brief   Copy sizes up to this value are done by fixed size loads and stores.
+ */
+#define MEMCOPY_SMALL_SIZE      16u
+
+/**
+ * @brief   Smallest copy size done by non-temporal (streaming) stores on
+ *          memCopyStream, below it streaming stores never pay off.
+ */
+#ifndef MEMCOPY_STREAM_SIZE
+#define MEMCOPY_STREAM_SIZE     (32u * 1024u)
+#endif
+
+/**
+ * @brief   Copy kernels for large blocks available to be selected at runtime.
+ */
+typedef enum
+{
+   MEMCOPY_GENERIC = 0,    //!< Plain C library memcpy, no streaming stores.
+   MEMCOPY_SSE2,           //!< 16 bytes SSE2 streaming kernel.
+   MEMCOPY_AVX2            //!< 32 bytes AVX2 streaming kernel.
+} eMemCopyKernel_t;
+
+/**
+ * @brief   Function to copy a block of memory: fixed size moves without loop
+ *          for small blocks, library memcpy for the others. The destination
+ *          stays in cache, so it is the copy for data read back soon.
+ *          Source and destination must not overlap.
+ * @param   *dst  Destination buffer.
+ * @param   *src  Source buffer.
+ * @param   size  Amount of bytes to be copied.
+ */
+void memCopy(void *dst, const void *src, u32_t size);
+
+/**
+ * @brief   Function to copy a block of memory written once and not read back
+ *          soon. From MEMCOPY_STREAM_SIZE it uses non-temporal stores by the
+ *          kernel selected, so the destination doesn't evict the working set
+ *          from cache. Smaller blocks are copied as memCopy does.
+ *          Source and destination must not overlap.
+ * @param   *dst  Destination buffer.
+ * @param   *src  Source buffer.
+ * @param   size  Amount of bytes to be copied.
+ */
+void memCopyStream(void *dst, const void *src, u32_t size);
+
+/**
+ * @brief   Function to select which copy kernel will be used by memCopyStream
+ *          for blocks from MEMCOPY_STREAM_SIZE.
+ * @param   kernel   Kernel to be used.
+ * @return  TRUE     Kernel supported by running CPU and selected.
+ *          FALSE    Kernel not supported, the current selection is kept.
+ */
+bool_t setMemCopyKernel(eMemCopyKernel_t kernel);
+
+/**
+ * @brief   Function to get the copy kernel in use by memCopyStream.
+ * @return  Kernel in use, the best supported one when not set by setMemCopyKernel.
+ */
+eMemCopyKernel_t getMemCopyKernel(void);
+
+#endif /* SRC_MEMCOPY_H_ */
@@ -0,0 +1,223 @@
+/*
+ * numa.c
+ *
+ *  Per NUMA node memory arenas used by pointers manager.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "defs.h"
+#include "numa.h"
+#include "debug.h"
+
+#define NUMA_MPOL_BIND     2u    //!< Memory policy to bind pages to a node set.
+#define NUMA_MIN_SHIFT     4u    //!< Smallest block class, 16 bytes.
+#define NUMA_CLASSES       13u   //!< Block classes from 16 bytes up to 64 KB.
+
+/**
+ * @brief   Arena of one node, blocks are taken by size class from a free list
+ *          or from the arena top. Released blocks keep the free list link at
+ *          its first bytes.
+ */
+typedef struct
+{
+   u8_t  *base;                     //!< Arena start address.
+   u32_t  size;                     //!< Arena size in bytes.
+   u32_t  top;                      //!< Offset of first never used byte.
+   void  *freeList[NUMA_CLASSES];   //!< Released blocks by size class.
+} numaArena_t;
+
+static numaArena_t arena[NUMA_MAX_NODES];
+static u16_t       numArenas = 0;
+
+static u16_t getSizeClass(const u16_t size)
+{
+   u16_t cls = 0;
+
+   while ((1u << (cls + NUMA_MIN_SHIFT)) < size)
+   {
+      cls++;
+   }
+
+   return (cls);
+}
+
+u16_t getNumaNodes(void)
+{
+   u16_t nodes = 1;
+   FILE *file = fopen("/sys/devices/system/node/online", "r");
+
+   if (file == NULL)
+   {
+      return (nodes);
+   }
+
+   //List format is like "0", "0-1" or "0,2-3", the greatest number gives node count.
+   DEF_BUFFER(char, line, 64);
+
+   if (fgets(line, sizeof(line), file) != NULL)
+   {
+      for (char *pos = line; *pos != '\0'; pos++)
+      {
+         if ((*pos >= '0') && (*pos <= '9'))
+         {
+            u16_t node = (u16_t)strtoul(pos, &pos, 10);
+
+            if (node >= nodes)
+            {
+               nodes = node + 1;
+            }
+
+            pos--;
+         }
+      }
+   }
+
+   fclose(file);
+
+   return ((nodes > NUMA_MAX_NODES) ? NUMA_MAX_NODES : nodes);
+}
+
+u16_t getCurrentNumaNode(void)
+{
+   unsigned int cpu = 0;
+   unsigned int node = 0;
+
+   //glibc getcpu goes through vDSO, no kernel entry on each call.
+   if (getcpu(&cpu, &node) != 0)
+   {
+      return (0);
+   }
+
+   return (((numArenas > 0) && (node >= numArenas)) ? 0 : (u16_t)node);
+}
+
+bool_t initNumaArenas(const u32_t arenaSize)
+{
+   ASSERT(numArenas == 0);
+   ASSERT(arenaSize > 0);
+
+   if ((numArenas > 0) || (arenaSize == 0))
+   {
+      return (FALSE);
+   }
+
+   u16_t nodes = getNumaNodes();
+
+   for (u16_t node = 0; node < nodes; node++)
+   {
+      void *base = mmap(NULL, arenaSize, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+      if (base == MAP_FAILED)
+      {
+         ERROR("Node arena allocation error.");
+         endNumaArenas();
+         return (FALSE);
+      }
+
+      if (nodes > 1)
+      {
+         //Pages are not touched yet, so binding takes effect on first touch.
+         unsigned long mask = 1ul << node;
+
+         if (syscall(SYS_mbind, base, arenaSize, NUMA_MPOL_BIND, &mask, NUMA_MAX_NODES + 1, 0) != 0)
+         {
+            WARNING("Node arena couldn't be bound, first touch policy is used.");
+         }
+      }
+
+      memset(&arena[node], (BYTE)0, sizeof(arena[node]));
+      arena[node].base = (u8_t*)base;
+      arena[node].size = arenaSize;
+      numArenas++;
+   }
+
+   return (TRUE);
+}
+
+void endNumaArenas(void)
+{
+   for (u16_t node = 0; node < numArenas; node++)
+   {
+      munmap(arena[node].base, arena[node].size);
+      memset(&arena[node], (BYTE)0, sizeof(arena[node]));
+   }
+
+   numArenas = 0;
+}
+
+bool_t isNumaEnabled(void)
+{
+   return ((numArenas > 0) ? TRUE : FALSE);
+}
+
+void *numaAlloc(const u16_t node, const u16_t size)
+{
+   if ((node >= numArenas) || (size == 0))
+   {
+      return (NULL);
+   }
+
+   numaArena_t *pArena = &arena[node];
+   u16_t        cls    = getSizeClass(size);
+   u32_t        bytes  = 1u << (cls + NUMA_MIN_SHIFT);
+   void        *block  = pArena->freeList[cls];
+
+   if (block != NULL)
+   {
+      pArena->freeList[cls] = *(void**)block;
+   }
+   else if ((pArena->top + bytes) <= pArena->size)
+   {
+      //Fresh pages from mmap are already cleared.
+      block = pArena->base + pArena->top;
+      pArena->top += bytes;
+      return (block);
+   }
+   else
+   {
+      return (NULL);
+   }
+
+   memset(block, (BYTE)0, bytes);
+
+   return (block);
+}
+
+bool_t numaFree(void *block, const u16_t size)
+{
+   u16_t node = getNumaNodeOf(block);
+
+   if (node == NUMA_NODE_UNKNOWN)
+   {
+      return (FALSE);
+   }
+
+   u16_t cls = getSizeClass(size);
+
+   *(void**)block = arena[node].freeList[cls];
+   arena[node].freeList[cls] = block;
+
+   return (TRUE);
+}
+
+u16_t getNumaNodeOf(const void *block)
+{
+   const u8_t *addr = (const u8_t*)block;
+
+   for (u16_t node = 0; node < numArenas; node++)
+   {
+      if ((addr >= arena[node].base) && (addr < (arena[node].base + arena[node].size)))
+      {
+         return (node);
+      }
+   }
+
+   return (NUMA_NODE_UNKNOWN);
+}
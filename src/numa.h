@@ -0,0 +1,82 @@
+/*
+ * numa.h
+ *
+ *  Per NUMA node memory arenas used by pointers manager.
+ */
+
+#ifndef SRC_NUMA_H_
+#define SRC_NUMA_H_
+
+#include "defs.h"
+
+#define NUMA_MAX_NODES     8u                //!< Greatest number of nodes handled.
+#define NUMA_NODE_UNKNOWN  ((u16_t)0xFFFF)   //!< Memory out of any node arena.
+
+/**
+ * @brief   Function to create one memory arena for each NUMA node found, every
+ *          arena is bound to its node by mbind, for a machine without NUMA a
+ *          single arena is created for node 0.
+ * @param   arenaSize   Size in bytes of each node arena.
+ * @return  TRUE        Successful, arenas created.
+ *          FALSE       Error or arenas already created.
+ */
+bool_t initNumaArenas(u32_t arenaSize);
+
+
+/**
+ * @brief   Function to release all node arenas, blocks still allocated from
+ *          them become invalid.
+ */
+void endNumaArenas(void);
+
+
+/**
+ * @brief   Function to check node arenas creation.
+ * @return  TRUE     Node arenas created.
+ *          FALSE    Node arenas not created.
+ */
+bool_t isNumaEnabled(void);
+
+
+/**
+ * @brief   Function to get the number of NUMA nodes on running machine.
+ * @return  1..NUMA_MAX_NODES  Number of nodes, 1 for a machine without NUMA.
+ */
+u16_t getNumaNodes(void);
+
+
+/**
+ * @brief   Function to get the NUMA node of the CPU running the calling thread.
+ * @return  0..N  Node number, 0 when it can't be found.
+ */
+u16_t getCurrentNumaNode(void);
+
+
+/**
+ * @brief   Function to allocate a cleared block from the arena of a node.
+ * @param   node  Node number.
+ * @param   size  Block size in bytes.
+ * @return  Block address, NULL for node arena exhausted or invalid parameter.
+ */
+void *numaAlloc(u16_t node, u16_t size);
+
+
+/**
+ * @brief   Function to release a block allocated by numaAlloc.
+ * @param   *block   Block address.
+ * @param   size     Block size used at allocation.
+ * @return  TRUE     Block released.
+ *          FALSE    Block is out of node arenas.
+ */
+bool_t numaFree(void *block, u16_t size);
+
+
+/**
+ * @brief   Function to get the node where a block lives.
+ * @param   *block   Block address.
+ * @return  0..N                 Node number of the arena containing the block.
+ *          NUMA_NODE_UNKNOWN    Block is out of node arenas.
+ */
+u16_t getNumaNodeOf(const void *block);
+
+#endif /* SRC_NUMA_H_ */
@@ -2,11 +2,222 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
 #include "defs.h"
 #include "pointers.h"
+#include "memcopy.h"
+#include "numa.h"
+#include "lz.h"
 #include "debug.h"
 
 static ptr_t *ptr = NULL;
+static u32_t  numaFallbacks = 0;   //!< Blocks allocated from heap because node arena was exhausted.
+static u16_t *share = NULL;   //!< Next handle sharing the same block (ring), 0 for a not shared handle.
+static u16_t *pinned = NULL;  //!< Number of pending asynchronous requests by handle.
+
+#define COLD_MIN_SIZE   64u   //!< Smaller blocks are not worth compressing.
+
+static u32_t      *coldAccess = NULL;  //!< Last access time in seconds by handle, NULL for cold compression disabled.
+static u16_t      *coldSize   = NULL;  //!< Compressed size by handle, 0 for a not compressed block.
+static void      **coldData   = NULL;  //!< Compressed copy by handle, handle pointer is NULL meanwhile.
+static u32_t       coldIdle   = 0;     //!< Idle seconds for a block to be compressed.
+static coldStats_t coldStats;          //!< Cold compression statistics.
+
+/**
+ * @brief   Function to allocate a cleared block, from the arena of calling
+ *          thread node when node arenas are enabled, from heap otherwise or
+ *          when the node arena is exhausted.
+ */
+static void *allocBlock(const u16_t size)
+{
+   if (isNumaEnabled())
+   {
+      void *block = numaAlloc(getCurrentNumaNode(), size);
+
+      if (block != NULL)
+      {
+         return (block);
+      }
+
+      if (numaFallbacks++ == 0)
+      {
+         WARNING("Node arena exhausted, blocks are allocated from heap.");
+      }
+   }
+
+   return (CALLOC(size));
+}
+
+/**
+ * @brief   Function to release a block allocated by allocBlock, or the
+ *          compressed copy of a cold block.
+ */
+static void freeBlock(const u16_t hnd)
+{
+   if ((coldSize != NULL) && (coldSize[hnd] != 0))
+   {
+      coldStats.blocks--;
+      coldStats.bytesSaved -= ptr[hnd].size - coldSize[hnd];
+      coldSize[hnd] = 0;
+      FREE(coldData[hnd]);
+   }
+   else if (numaFree(ptr[hnd].ptr, ptr[hnd].size) == TRUE)
+   {
+      ptr[hnd].ptr = NULL;
+   }
+   else
+   {
+      FREE(ptr[hnd].ptr);
+   }
+}
+
+/**
+ * @brief   Function to remove a handle from the ring of handles sharing its block.
+ */
+static void unlinkShare(const u16_t hnd)
+{
+   u16_t prev = hnd;
+
+   while (share[prev] != hnd)
+   {
+      prev = share[prev];
+   }
+
+   share[prev] = share[hnd];
+   share[hnd] = 0;
+
+   //Last reference left is not shared anymore.
+   if (share[prev] == prev)
+   {
+      share[prev] = 0;
+   }
+}
+
+/**
+ * @brief   Function to get the lowest handle of the ring sharing a block.
+ */
+static u16_t getLowestShare(const u16_t hnd)
+{
+   u16_t lowest = hnd;
+
+   for (u16_t idx = share[hnd]; idx != hnd; idx = share[idx])
+   {
+      if (idx < lowest)
+      {
+         lowest = idx;
+      }
+   }
+
+   return (lowest);
+}
+
+/**
+ * @brief   Function to get monotonic coarse seconds used for last access tracking.
+ */
+static u32_t getSeconds(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+   return ((u32_t)ts.tv_sec);
+}
+
+/**
+ * @brief   Function to decompress a cold block back into a block from allocBlock.
+ */
+static bool_t expandHandle(const u16_t hnd)
+{
+   struct timespec start, stop;
+   clock_gettime(CLOCK_MONOTONIC, &start);
+
+   void *block = allocBlock(ptr[hnd].size);
+
+   if (block == NULL)
+   {
+      ERROR("Memory allocation error.");
+      return (FALSE);
+   }
+
+   if (lzDecompress(coldData[hnd], coldSize[hnd], block, ptr[hnd].size) == FALSE)
+   {
+      ERROR("Corrupted cold block.");
+
+      if (numaFree(block, ptr[hnd].size) == FALSE)
+      {
+         FREE(block);
+      }
+
+      return (FALSE);
+   }
+
+   freeBlock(hnd);
+   ptr[hnd].ptr = block;
+
+   clock_gettime(CLOCK_MONOTONIC, &stop);
+
+   u64_t ns = ((u64_t)(stop.tv_sec - start.tv_sec) * 1000000000ull) + (u64_t)stop.tv_nsec - (u64_t)start.tv_nsec;
+
+   coldStats.decompressions++;
+   coldStats.decompressNs += ns;
+
+   if (ns > coldStats.maxDecompressNs)
+   {
+      coldStats.maxDecompressNs = ns;
+   }
+
+   return (TRUE);
+}
+
+/**
+ * @brief   Function to compress a block, it is kept as is when not shrinking
+ *          at least by one eighth. Compressed copy is kept apart and handle
+ *          pointer is cleared, so a kept entry from getPointerTo is never
+ *          read as block data.
+ */
+static bool_t compressHandle(const u16_t hnd)
+{
+   static u8_t scratch[0xFFFF];
+
+   u16_t size = ptr[hnd].size;
+   u32_t packedSize = lzCompress(ptr[hnd].ptr, size, scratch, size - (size / 8));
+
+   if (packedSize == 0)
+   {
+      return (FALSE);
+   }
+
+   void *packed = CALLOC(packedSize);
+
+   if (packed == NULL)
+   {
+      return (FALSE);
+   }
+
+   memcpy(packed, scratch, packedSize);
+   freeBlock(hnd);
+   coldData[hnd] = packed;
+   coldSize[hnd] = (u16_t)packedSize;
+
+   coldStats.blocks++;
+   coldStats.bytesSaved += size - packedSize;
+   coldStats.compressions++;
+
+   return (TRUE);
+}
+
+/**
+ * @brief   Function to mark an access to a handle, a cold block is decompressed.
+ */
+static bool_t accessHandle(const u16_t hnd)
+{
+   if (coldAccess == NULL)
+   {
+      return (TRUE);
+   }
+
+   coldAccess[hnd] = getSeconds();
+
+   return ((coldSize[hnd] == 0) ? TRUE : expandHandle(hnd));
+}
 
 void exitPointerManager(void)
 {
@@ -51,6 +262,20 @@ bool_t initPointerManager(u16_t numPointers)
       return (FALSE);
    }
 
+   share = CALLOC(numPointers * sizeof(u16_t));
+   pinned = CALLOC(numPointers * sizeof(u16_t));
+
+   ASSERT((share != NULL) && (pinned != NULL));
+
+   if ((share == NULL) || (pinned == NULL))
+   {
+      ERROR("Memory allocation error.");
+      FREE(ptr);
+      FREE(share);
+      FREE(pinned);
+      return (FALSE);
+   }
+
    /* Save data at position 0 */
    ptr[0].size = numPointers; //Store number of pointers.
    ptr[0].ptr = ptr; //Point to itself.
@@ -58,6 +283,25 @@ bool_t initPointerManager(u16_t numPointers)
    return (TRUE);
 }
 
+bool_t initPointerManagerNuma(u16_t numPointers, u32_t arenaSize)
+{
+   if (initPointerManager(numPointers) == FALSE)
+   {
+      return (FALSE);
+   }
+
+   numaFallbacks = 0;
+
+   if (initNumaArenas(arenaSize) == FALSE)
+   {
+      ERROR("Node arenas couldn't be created.");
+      endPointerManager();
+      return (FALSE);
+   }
+
+   return (TRUE);
+}
+
 bool_t endPointerManager(void)
 {
    ASSERT(ptr != NULL);
@@ -80,6 +324,12 @@ bool_t endPointerManager(void)
    }
 
    FREE(ptr);
+   FREE(share);
+   FREE(pinned);
+   FREE(coldAccess);
+   FREE(coldSize);
+   FREE(coldData);
+   endNumaArenas();
 
    return (res);
 }
@@ -113,7 +363,7 @@ u16_t allocMemory(const u16_t size)
       {
          //Found a free handle position.
 
-         ptr[hnd_pos].ptr = CALLOC(size);
+         ptr[hnd_pos].ptr = allocBlock(size);
          ASSERT(ptr[hnd_pos].ptr != NULL);
 
          if (ptr[hnd_pos].ptr == NULL)
@@ -131,6 +381,7 @@ u16_t allocMemory(const u16_t size)
          //store size of allocated memory and save the handle position.
          ptr[hnd_pos].size = size;
          hnd = hnd_pos;
+         accessHandle(hnd);
 
          //Stop looping iteration and return the index number as a handle position.
          break;
@@ -147,7 +398,23 @@ bool_t freeMemory(const u16_t hnd)
       return (FALSE);
    }
 
-   FREE(ptr[hnd].ptr);
+   if (isPinned(hnd))
+   {
+      ERROR("Handle memory in use by a pending request.");
+      return (FALSE);
+   }
+
+   if (isShared(hnd))
+   {
+      //Other handles still reference the block, release only this reference.
+      unlinkShare(hnd);
+      ptr[hnd].ptr = NULL;
+   }
+   else
+   {
+      freeBlock(hnd);
+   }
+
    ptr[hnd].size = 0;
 
    return (isFree(hnd));
@@ -183,6 +450,11 @@ bool_t getPointerTo(ptr_t **p2p, const u16_t hnd)
       return (FALSE);
    }
 
+   if (accessHandle(hnd) == FALSE)
+   {
+      return (FALSE);
+   }
+
    *p2p = (ptr_t*)&ptr[hnd];
 
    return (TRUE);
@@ -202,9 +474,10 @@ u32_t getUsedSize(void)
 
    for (u16_t idx = 1; idx < ptr[0].size; idx++)
    {
-      if (isValid(idx))
+      //A shared block is counted once, by the lowest handler referencing it.
+      if (isValid(idx) && (isNotShared(idx) || (getLowestShare(idx) == idx)))
       {
-         size += ptr[idx].size;
+         size += ((coldSize != NULL) && (coldSize[idx] != 0)) ? coldSize[idx] : ptr[idx].size;
       }
    }
 
@@ -309,8 +582,264 @@ bool_t memCopyTo(u8_t  *pdata,
       return (FALSE);
    }
 
-   memcpy((void*)((u8_t*)ptr[hnd].ptr + offset_dest),
-          (void*)(pdata + offset_orig), data_size);
+   //Copy on write, a shared block is never changed.
+   if ((accessHandle(hnd) == FALSE) || (unshareHandle(hnd) == FALSE))
+   {
+      return (FALSE);
+   }
+
+   memCopy((void*)((u8_t*)ptr[hnd].ptr + offset_dest),
+           (void*)(pdata + offset_orig), data_size);
+
+   return (TRUE);
+}
+
+u32_t getNumaFallbacks(void)
+{
+   return (numaFallbacks);
+}
+
+u16_t getHandleNode(const u16_t hnd)
+{
+   if (isNotInitialized() || isNotValid(hnd) || isFree(hnd))
+   {
+      return (NUMA_NODE_UNKNOWN);
+   }
+
+   return (getNumaNodeOf(ptr[hnd].ptr));
+}
+
+u16_t shareHandle(const u16_t hnd)
+{
+   u16_t hnd_new = 0;
+
+   if (isNotInitialized() || isNotValid(hnd) || isFree(hnd))
+   {
+      ERROR("Invalid parameter.");
+      return (hnd_new);
+   }
+
+   //Kernel may still write into a pinned block, a new reference would see it changing.
+   if (isPinned(hnd))
+   {
+      ERROR("Handle memory in use by a pending request.");
+      return (hnd_new);
+   }
+
+   //Shared blocks are never compressed.
+   if (accessHandle(hnd) == FALSE)
+   {
+      return (hnd_new);
+   }
+
+   for (u16_t hnd_pos = 1; hnd_pos < ptr[0].size; hnd_pos++)
+   {
+      if (isFree(hnd_pos))
+      {
+         ptr[hnd_pos].ptr = ptr[hnd].ptr;
+         ptr[hnd_pos].size = ptr[hnd].size;
+
+         //Insert new handle into the ring, next to the shared one.
+         share[hnd_pos] = (share[hnd] == 0) ? hnd : share[hnd];
+         share[hnd] = hnd_pos;
+         hnd_new = hnd_pos;
+         accessHandle(hnd_new);
+         break;
+      }
+   }
+
+   return (hnd_new);
+}
+
+bool_t unshareHandle(const u16_t hnd)
+{
+   if (isNotInitialized() || isNotValid(hnd))
+   {
+      return (FALSE);
+   }
+
+   if (isNotShared(hnd))
+   {
+      return (TRUE);
+   }
+
+   //Block can't move while the kernel may still access it.
+   if (isPinned(hnd))
+   {
+      ERROR("Handle memory in use by a pending request.");
+      return (FALSE);
+   }
+
+   void *block = allocBlock(ptr[hnd].size);
+
+   if (block == NULL)
+   {
+      ERROR("Memory allocation error.");
+      return (FALSE);
+   }
+
+   //Destination is about to be written, keep it in cache.
+   memcpy(block, ptr[hnd].ptr, ptr[hnd].size);
+   unlinkShare(hnd);
+   ptr[hnd].ptr = block;
 
    return (TRUE);
 }
+
+bool_t isShared(const u16_t hnd)
+{
+   return ((share != NULL) && isValid(hnd) && (share[hnd] != 0));
+}
+
+bool_t isNotShared(const u16_t hnd)
+{
+   return (!isShared(hnd));
+}
+
+u16_t getShareCount(const u16_t hnd)
+{
+   if (isNotInitialized() || isNotValid(hnd) || isFree(hnd))
+   {
+      return (0);
+   }
+
+   u16_t count = 1;
+
+   for (u16_t idx = share[hnd]; (idx != 0) && (idx != hnd); idx = share[idx])
+   {
+      count++;
+   }
+
+   return (count);
+}
+
+bool_t enableColdCompression(const u32_t idleSeconds)
+{
+   if (isNotInitialized())
+   {
+      return (FALSE);
+   }
+
+   if (coldAccess == NULL)
+   {
+      coldAccess = CALLOC(ptr[0].size * sizeof(u32_t));
+      coldSize = CALLOC(ptr[0].size * sizeof(u16_t));
+      coldData = CALLOC(ptr[0].size * sizeof(void*));
+
+      if ((coldAccess == NULL) || (coldSize == NULL) || (coldData == NULL))
+      {
+         ERROR("Memory allocation error.");
+         FREE(coldAccess);
+         FREE(coldSize);
+         FREE(coldData);
+         return (FALSE);
+      }
+
+      memset(&coldStats, (BYTE)0, sizeof(coldStats));
+
+      //Idle time starts counting now for blocks already allocated.
+      u32_t now = getSeconds();
+
+      for (u16_t idx = 1; idx < ptr[0].size; idx++)
+      {
+         coldAccess[idx] = now;
+      }
+   }
+
+   coldIdle = idleSeconds;
+
+   return (TRUE);
+}
+
+bool_t disableColdCompression(void)
+{
+   if (isNotInitialized() || (coldAccess == NULL))
+   {
+      return (FALSE);
+   }
+
+   bool_t res = TRUE;
+
+   for (u16_t idx = 1; idx < ptr[0].size; idx++)
+   {
+      if ((coldSize[idx] != 0) && (expandHandle(idx) == FALSE))
+      {
+         res = FALSE;
+      }
+   }
+
+   //Keep tracking while some block is still compressed.
+   if (res == TRUE)
+   {
+      FREE(coldAccess);
+      FREE(coldSize);
+      FREE(coldData);
+   }
+
+   return (res);
+}
+
+u16_t compressColdHandles(void)
+{
+   u16_t count = 0;
+
+   if (isNotInitialized() || (coldAccess == NULL))
+   {
+      return (count);
+   }
+
+   u32_t now = getSeconds();
+
+   for (u16_t idx = 1; idx < ptr[0].size; idx++)
+   {
+      if (isNotFree(idx) && isNotShared(idx) && !isPinned(idx) && (coldSize[idx] == 0) &&
+          (ptr[idx].size >= COLD_MIN_SIZE) && ((now - coldAccess[idx]) >= coldIdle) &&
+          (compressHandle(idx) == TRUE))
+      {
+         count++;
+      }
+   }
+
+   return (count);
+}
+
+bool_t getColdStats(coldStats_t *stats)
+{
+   if ((stats == NULL) || (coldAccess == NULL))
+   {
+      return (FALSE);
+   }
+
+   *stats = coldStats;
+
+   return (TRUE);
+}
+
+bool_t pinHandle(const u16_t hnd)
+{
+   if (isNotInitialized() || isNotValid(hnd) || isFree(hnd) || (pinned[hnd] == 0xFFFF))
+   {
+      return (FALSE);
+   }
+
+   pinned[hnd]++;
+
+   return (TRUE);
+}
+
+bool_t unpinHandle(const u16_t hnd)
+{
+   if (isNotInitialized() || isNotValid(hnd) || (pinned[hnd] == 0))
+   {
+      return (FALSE);
+   }
+
+   pinned[hnd]--;
+
+   return (TRUE);
+}
+
+bool_t isPinned(const u16_t hnd)
+{
+   return ((pinned != NULL) && isValid(hnd) && (pinned[hnd] > 0));
+}
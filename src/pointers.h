@@ -1,6 +1,7 @@
 #ifndef POINTERS_H
 #define POINTERS_H
 #include "defs.h"
+#include "numa.h"
 
 /**
  * @brief   Structure to declare an array of entries points for memory management.
@@ -14,6 +15,20 @@ typedef struct
 #pragma pack()
 
 
+/**
+ * @brief   Structure to report cold blocks compression statistics.
+ */
+typedef struct
+{
+   u32_t blocks;           //!< Blocks compressed at the moment.
+   u32_t bytesSaved;       //!< Bytes saved by blocks compressed at the moment.
+   u32_t compressions;     //!< Total of compressions done.
+   u32_t decompressions;   //!< Total of decompressions done.
+   u64_t decompressNs;     //!< Total decompression time in nanoseconds.
+   u64_t maxDecompressNs;  //!< Longest decompression time in nanoseconds.
+} coldStats_t;
+
+
 /**
  * @brief   Function to initialize pointer manager structure.
  * @param   numPointers Numbers of entries points to be allocated.
@@ -23,6 +38,20 @@ typedef struct
 bool_t initPointerManager( u16_t numPointers );
 
 
+/**
+ * @brief   Function to initialize pointer manager structure with one memory
+ *          arena for each NUMA node, handles are allocated from the arena of
+ *          the node running the calling thread. On a machine without NUMA a
+ *          single arena is used.
+ * @param   numPointers Numbers of entries points to be allocated.
+ * @param   arenaSize   Size in bytes of each node arena, when an arena is
+ *                      exhausted blocks are allocated from heap.
+ * @return  TRUE        Successful execution and initialization.
+ *          FALSE       An error happened or pointers manager can't be initialized.
+ */
+bool_t initPointerManagerNuma( u16_t numPointers, u32_t arenaSize );
+
+
 /**
  * @brief   Function called at exit main program. Here we can
  *          put deinitialize pointer memory for recovery allocated
@@ -69,7 +98,8 @@ u16_t allocMemory(u16_t size);
  * @brief   Function to release a specific handler position.
  * @param   hnd   Handle number to be released.
  * @return  TRUE  If successful on release handler position.
- *          FALSE For an error or pointers manager is not yet initialized.
+ *          FALSE For an error, handler pinned by a pending request or
+ *                pointers manager is not yet initialized.
  */
 bool_t freeMemory(u16_t hnd);
 
@@ -112,6 +142,9 @@ bool_t isNotValid( u16_t hnd );
 
 /**
  * @brief   Function to get an address pointer at handler structure entrie.
+ *          A cold block is decompressed first. Entry ptr is only valid until
+ *          the next compressColdHandles call, meanwhile the block is cold it
+ *          is NULL, so call again before using a kept entry.
  * @param   **ptr	Pointer to pointer where the structure address will be stored.
  * @param   hnd	Handler to get address and store into ptr.
  * @return  TRUE	Successful.
@@ -121,8 +154,10 @@ bool_t getPointerTo( ptr_t **ptr, u16_t hnd );
 
 
 /**
- * @brief   Function to get allocated memory by handlers.
- * @return  1..N  Allocated memory size in bytes.
+ * @brief   Function to get memory held by handlers blocks. A block shared by
+ *          several handlers is counted once, a cold (compressed) block is
+ *          counted by its compressed size.
+ * @return  1..N  Memory size in bytes held by handlers blocks.
  *          0     Error or pointers manager is not yet initialized.
  */
 u32_t getUsedSize( void );
@@ -163,7 +198,7 @@ u16_t getUsedHandles( void );
  * @param offset_dest   Offset into destination buffer handled by handler hnd and
  *                      where data bytes will be copied.
  * @return TRUE         For successful.
- *         FALSE        For error.
+ *         FALSE        For error, or shared handler pinned by a pending request.
  */
 bool_t memCopyTo(u8_t  *pdata,
                  u16_t size_orig,
@@ -172,6 +207,151 @@ bool_t memCopyTo(u8_t  *pdata,
                  u16_t hnd,
                  u16_t offset_dest);
 
+
+/**
+ * @brief   Function to get the NUMA node where the memory of a handler lives.
+ * @param   hnd   Handler number.
+ * @return  0..N                 Node number.
+ *          NUMA_NODE_UNKNOWN    Handler not in use, or its memory is out of
+ *                               node arenas (heap or arenas not enabled).
+ */
+u16_t getHandleNode( u16_t hnd );
+
+
+/**
+ * @brief   Function to get the number of blocks allocated from heap because
+ *          the node arena was exhausted. Blocks are rounded up to a power of
+ *          two size on arenas, so an arena may be exhausted before expected.
+ * @return  0..N  Number of blocks allocated from heap since initPointerManagerNuma.
+ */
+u32_t getNumaFallbacks( void );
+
+
+
+/**
+ * @brief   Function to get a new handler referencing the same memory block of
+ *          another handler, no data is copied. The block is released only by
+ *          the last handler referencing it. Writes by memCopyTo (or any other
+ *          write function of pointers manager) give the writer its own copy of
+ *          the block first, direct writes through getPointerTo must be preceded
+ *          by unshareHandle.
+ * @param   hnd   Handler number in use to be shared.
+ * @return  1..N  New handler number.
+ *          0     Invalid handler, no free handler or pointers manager is not yet initialized.
+ */
+u16_t shareHandle( u16_t hnd );
+
+
+/**
+ * @brief   Function to give a shared handler its own copy of the memory block.
+ * @param   hnd   Handler number.
+ * @return  TRUE  Handler not shared anymore, or it was not shared.
+ *          FALSE Invalid handler, handler pinned by a pending request or
+ *                memory allocation error.
+ */
+bool_t unshareHandle( u16_t hnd );
+
+
+/**
+ * @brief   Function to check if a handler memory block is shared.
+ * @param   hnd   Handler number.
+ * @return  TRUE  Memory block referenced by other handlers.
+ *          FALSE Memory block not shared or invalid handler.
+ */
+bool_t isShared( u16_t hnd );
+
+
+/**
+ * @brief   Function to check if a handler memory block is not shared.
+ * @param   hnd   Handler number.
+ * @return  TRUE  Memory block not shared or invalid handler.
+ *          FALSE Memory block referenced by other handlers.
+ */
+bool_t isNotShared( u16_t hnd );
+
+
+/**
+ * @brief   Function to get the number of handlers referencing a memory block.
+ * @param   hnd   Handler number.
+ * @return  1..N  Number of handlers, including hnd.
+ *          0     Handler not in use or pointers manager is not yet initialized.
+ */
+u16_t getShareCount( u16_t hnd );
+
+
+
+/**
+ * @brief   Function to enable compression of cold blocks. The last access of
+ *          each handler is tracked and compressColdHandles compresses blocks
+ *          idle for a time, they are decompressed transparently on next access
+ *          by getPointerTo or memCopyTo. Shared blocks are not compressed.
+ * @param   idleSeconds Idle time in seconds for a block to be compressed.
+ * @return  TRUE        Successful.
+ *          FALSE       Memory allocation error or pointers manager is not yet initialized.
+ */
+bool_t enableColdCompression( u32_t idleSeconds );
+
+
+/**
+ * @brief   Function to disable compression of cold blocks, all compressed
+ *          blocks are decompressed.
+ * @return  TRUE        Successful.
+ *          FALSE       Decompression error, compression not enabled or
+ *                      pointers manager is not yet initialized.
+ */
+bool_t disableColdCompression( void );
+
+
+/**
+ * @brief   Function to compress blocks idle for the time set at
+ *          enableColdCompression, it should be called periodically. Pinned
+ *          handlers (pending asynchronous I/O) are skipped. A compressed
+ *          handler entry ptr is NULL until it is accessed again by
+ *          getPointerTo or memCopyTo.
+ * @return  0..N  Number of blocks compressed.
+ */
+u16_t compressColdHandles( void );
+
+
+/**
+ * @brief   Function to get cold blocks compression statistics.
+ * @param   *stats   Where statistics will be stored.
+ * @return  TRUE     Successful.
+ *          FALSE    Invalid parameter or compression not enabled.
+ */
+bool_t getColdStats( coldStats_t *stats );
+
+
+
+/**
+ * @brief   Function to pin a handler memory block, a pinned block is not
+ *          moved (unshareHandle, cold compression), shared or released until
+ *          unpinned. Used while an asynchronous request may access the block.
+ *          Pins are counted, each pinHandle needs its unpinHandle.
+ * @param   hnd   Handler number in use.
+ * @return  TRUE  Handler pinned.
+ *          FALSE Invalid handler or pointers manager is not yet initialized.
+ */
+bool_t pinHandle( u16_t hnd );
+
+
+/**
+ * @brief   Function to release a pin taken by pinHandle.
+ * @param   hnd   Handler number.
+ * @return  TRUE  Pin released.
+ *          FALSE Invalid handler or handler not pinned.
+ */
+bool_t unpinHandle( u16_t hnd );
+
+
+/**
+ * @brief   Function to check if a handler memory block is pinned.
+ * @param   hnd   Handler number.
+ * @return  TRUE  Handler pinned.
+ *          FALSE Handler not pinned or invalid handler.
+ */
+bool_t isPinned( u16_t hnd );
+
 #endif /* POINTERS_H */
 
 
@@ -0,0 +1,121 @@
+/*
+ * typedpool.h
+ *
+ *  Fixed size object pools generated at compile time for a single type.
+ */
+
+#ifndef SRC_TYPEDPOOL_H_
+#define SRC_TYPEDPOOL_H_
+
+#include "defs.h"
+
+/**
+ * @brief   Marker stored at link array for a handle in use.
+ */
+#define TYPED_POOL_IN_USE    ((u16_t)0xFFFF)
+
+/**
+ * @brief   Macro to declare a pool of objects of one type, it should be used at
+ *          a header file. Objects are stored in a dense array with the element
+ *          size and alignment of the type, known at compile time, and they are
+ *          handled by numbers 1..elements like allocMemory handles.
+ *
+ *          Declared functions, where <type> is the type name:
+ *          u16_t   <type>PoolAlloc(void)        Alloc a cleared object, 0 for no free object.
+ *          bool_t  <type>PoolFree(u16_t hnd)    Release an object.
+ *          type   *<type>PoolGet(u16_t hnd)     Object address, NULL for invalid or free handle.
+ *          bool_t  <type>PoolIsUsed(u16_t hnd)  Handle in use.
+ *          u16_t   <type>PoolUsed(void)         Number of objects in use.
+ *          u16_t   <type>PoolSize(void)         Number of objects on pool.
+ *
+ *          Alloc and free are O(1): a handle is taken from the free list or, for
+ *          a never used position, from the top of the array.
+ *
+ * @param   type     Object type name, a single identifier (use typedef).
+ * @param   elements Number of objects on pool, from 1 up to 65534.
+ */
+#define DECLARE_TYPED_POOL(type, elements)                                       \
+   _Static_assert(((elements) > 0) && ((elements) < TYPED_POOL_IN_USE),          \
+                  "Invalid number of elements for " #type " pool.");             \
+                                                                                 \
+   typedef struct                                                                \
+   {                                                                             \
+      type  item[(elements)];       /* Dense object storage. */                  \
+      u16_t link[(elements) + 1];   /* Next free handle or in use marker. */     \
+      u16_t freeHead;               /* First released handle, 0 for none. */     \
+      u16_t top;                    /* Last handle taken from array top. */      \
+      u16_t used;                   /* Number of handles in use. */              \
+   } type##Pool_t;                                                               \
+                                                                                 \
+   extern type##Pool_t type##Pool;                                               \
+                                                                                 \
+   static inline u16_t type##PoolSize(void)                                      \
+   {                                                                             \
+      return ((u16_t)(elements));                                                \
+   }                                                                             \
+                                                                                 \
+   static inline bool_t type##PoolIsUsed(const u16_t hnd)                        \
+   {                                                                             \
+      return (((hnd > 0) && (hnd <= (elements)) &&                               \
+               (type##Pool.link[hnd] == TYPED_POOL_IN_USE)) ? TRUE : FALSE);     \
+   }                                                                             \
+                                                                                 \
+   static inline u16_t type##PoolAlloc(void)                                     \
+   {                                                                             \
+      u16_t hnd = type##Pool.freeHead;                                           \
+                                                                                 \
+      if (hnd != 0)                                                              \
+      {                                                                          \
+         type##Pool.freeHead = type##Pool.link[hnd];                             \
+      }                                                                          \
+      else if (type##Pool.top < (elements))                                      \
+      {                                                                          \
+         hnd = ++type##Pool.top;                                                 \
+      }                                                                          \
+      else                                                                       \
+      {                                                                          \
+         return (0);                                                             \
+      }                                                                          \
+                                                                                 \
+      type##Pool.link[hnd] = TYPED_POOL_IN_USE;                                  \
+      type##Pool.used++;                                                         \
+      memset(&type##Pool.item[hnd - 1], (BYTE)0, sizeof(type));                  \
+                                                                                 \
+      return (hnd);                                                              \
+   }                                                                             \
+                                                                                 \
+   static inline bool_t type##PoolFree(const u16_t hnd)                          \
+   {                                                                             \
+      if (type##PoolIsUsed(hnd) == FALSE)                                        \
+      {                                                                          \
+         return (FALSE);                                                         \
+      }                                                                          \
+                                                                                 \
+      type##Pool.link[hnd] = type##Pool.freeHead;                                \
+      type##Pool.freeHead = hnd;                                                 \
+      type##Pool.used--;                                                         \
+                                                                                 \
+      return (TRUE);                                                             \
+   }                                                                             \
+                                                                                 \
+   static inline type *type##PoolGet(const u16_t hnd)                            \
+   {                                                                             \
+      return ((type##PoolIsUsed(hnd) == TRUE) ?                                  \
+              &type##Pool.item[hnd - 1] : NULL);                                 \
+   }                                                                             \
+                                                                                 \
+   static inline u16_t type##PoolUsed(void)                                      \
+   {                                                                             \
+      return (type##Pool.used);                                                  \
+   }                                                                             \
+                                                                                 \
+   extern type##Pool_t type##Pool
+
+/**
+ * @brief   Macro to define the storage of a pool declared by DECLARE_TYPED_POOL,
+ *          it must be used once at a source file.
+ * @param   type  Object type name used at DECLARE_TYPED_POOL.
+ */
+#define DEFINE_TYPED_POOL(type) type##Pool_t type##Pool
+
+#endif /* SRC_TYPEDPOOL_H_ */